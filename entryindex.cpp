@@ -0,0 +1,242 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "entryindex.h"
+
+#include <tinyxml2.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+  const char* indexVersion{ "1" };
+
+  std::string attribute( const tinyxml2::XMLElement* element, const char* name )
+  {
+    const char* value{ element->Attribute(name) };
+    return value ? value : "";
+  }
+
+  long long mtimeAttribute( const tinyxml2::XMLElement* element )
+  {
+    const char* value{ element->Attribute("mtime") };
+    return value ? std::strtoll( value, nullptr, 10 ) : -1;
+  }
+
+  void mkdirs( const std::string& path )
+  {
+    for( auto pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1) )
+    {
+      mkdir( path.substr(0, pos).c_str(), 0755 );
+    }
+    mkdir( path.c_str(), 0755 );
+  }
+}
+
+EntryIndex::EntryIndex()
+{
+
+}
+
+EntryIndex::~EntryIndex()
+{
+
+}
+
+EntryIndex::Directories& EntryIndex::source( const std::string& key )
+{
+  return m_sources[key];
+}
+
+const EntryIndex::Directories* EntryIndex::findSource( const std::string& key ) const
+{
+  auto it = m_sources.find(key);
+  return it != m_sources.end() ? &it->second : nullptr;
+}
+
+bool EntryIndex::hasSource( const std::string& key ) const
+{
+  return findSource(key) != nullptr;
+}
+
+bool EntryIndex::retainSources( const std::set<std::string>& keys )
+{
+  bool dropped{ false };
+  for( auto it = m_sources.begin(); it != m_sources.end(); )
+  {
+    if( keys.find(it->first) == keys.end() )
+    {
+      it = m_sources.erase(it);
+      dropped = true;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  return dropped;
+}
+
+std::string EntryIndex::defaultPath( const std::string& configFile )
+{
+  std::string cacheDir;
+  const char* xdgCache{ std::getenv("XDG_CACHE_HOME") };
+  const char* home{ std::getenv("HOME") };
+  if( xdgCache && *xdgCache ) cacheDir = xdgCache;
+  else if( home && *home ) cacheDir = std::string(home) + "/.cache";
+  else return "";
+
+  // Name the index after the config's absolute path. FNV-1a rather than std::hash,
+  // which may change between builds and orphan the index
+  std::string configPath( configFile );
+  if( char* resolved = realpath( configFile.c_str(), nullptr ) )
+  {
+    configPath = resolved;
+    std::free( resolved );
+  }
+  unsigned long long hash{ 14695981039346656037ULL };
+  for( unsigned char c : configPath )
+  {
+    hash = (hash ^ c) * 1099511628211ULL;
+  }
+  char name[32];
+  std::snprintf( name, sizeof(name), "index-%016llx.xml", hash );
+  return cacheDir + "/osglauncher/" + name;
+}
+
+bool EntryIndex::load( const std::string& path )
+{
+  m_sources.clear();
+
+  tinyxml2::XMLDocument doc;
+  if( doc.LoadFile( path.c_str() ) != tinyxml2::XML_SUCCESS )
+  {
+    // Normal on first run
+    return false;
+  }
+
+  const tinyxml2::XMLElement* xmlIndex{ doc.FirstChildElement("index") };
+  if( xmlIndex == nullptr || attribute(xmlIndex, "version") != indexVersion )
+  {
+    std::cerr << "WARNING: Ignoring outdated entry index " << path << std::endl;
+    return false;
+  }
+
+  for( auto xmlSource = xmlIndex->FirstChildElement("source"); xmlSource; xmlSource = xmlSource->NextSiblingElement("source") )
+  {
+    auto& directories = m_sources[attribute(xmlSource, "key")];
+    for( auto xmlDir = xmlSource->FirstChildElement("dir"); xmlDir; xmlDir = xmlDir->NextSiblingElement("dir") )
+    {
+      auto& dir = directories[attribute(xmlDir, "path")];
+      dir.mtime = mtimeAttribute(xmlDir);
+      for( auto xmlSubdir = xmlDir->FirstChildElement("subdir"); xmlSubdir; xmlSubdir = xmlSubdir->NextSiblingElement("subdir") )
+      {
+        dir.subdirs.push_back( attribute(xmlSubdir, "name") );
+      }
+      for( auto xmlFile = xmlDir->FirstChildElement("file"); xmlFile; xmlFile = xmlFile->NextSiblingElement("file") )
+      {
+        File file;
+        file.name = attribute(xmlFile, "name");
+        file.mtime = mtimeAttribute(xmlFile);
+        file.title = attribute(xmlFile, "title");
+        file.command = attribute(xmlFile, "command");
+        file.image = attribute(xmlFile, "image");
+        file.hidden = xmlFile->BoolAttribute("hidden");
+        dir.files.push_back( file );
+      }
+    }
+  }
+  return true;
+}
+
+bool EntryIndex::save( const std::string& path ) const
+{
+  tinyxml2::XMLDocument doc;
+  doc.InsertEndChild( doc.NewDeclaration() );
+  auto xmlIndex = doc.NewElement("index");
+  xmlIndex->SetAttribute("version", indexVersion);
+  doc.InsertEndChild( xmlIndex );
+
+  for( auto& source : m_sources )
+  {
+    auto xmlSource = doc.NewElement("source");
+    xmlSource->SetAttribute("key", source.first.c_str());
+    xmlIndex->InsertEndChild( xmlSource );
+
+    for( auto& dir : source.second )
+    {
+      auto xmlDir = doc.NewElement("dir");
+      xmlDir->SetAttribute("path", dir.first.c_str());
+      xmlDir->SetAttribute("mtime", std::to_string(dir.second.mtime).c_str());
+      xmlSource->InsertEndChild( xmlDir );
+
+      for( auto& subdir : dir.second.subdirs )
+      {
+        auto xmlSubdir = doc.NewElement("subdir");
+        xmlSubdir->SetAttribute("name", subdir.c_str());
+        xmlDir->InsertEndChild( xmlSubdir );
+      }
+      for( auto& file : dir.second.files )
+      {
+        auto xmlFile = doc.NewElement("file");
+        xmlFile->SetAttribute("name", file.name.c_str());
+        xmlFile->SetAttribute("mtime", std::to_string(file.mtime).c_str());
+        if( !file.title.empty() ) xmlFile->SetAttribute("title", file.title.c_str());
+        if( !file.command.empty() ) xmlFile->SetAttribute("command", file.command.c_str());
+        if( !file.image.empty() ) xmlFile->SetAttribute("image", file.image.c_str());
+        if( file.hidden ) xmlFile->SetAttribute("hidden", true);
+        xmlDir->InsertEndChild( xmlFile );
+      }
+    }
+  }
+
+  auto lastSlash = path.find_last_of('/');
+  if( lastSlash != std::string::npos && lastSlash > 0 )
+  {
+    mkdirs( path.substr(0, lastSlash) );
+  }
+
+  // Write and rename, so a crash can't leave a truncated index. The temporary
+  // file is per process, in case the same config is launched twice
+  std::string tmpPath( path + "." + std::to_string( getpid() ) + ".tmp" );
+  if( doc.SaveFile( tmpPath.c_str() ) != tinyxml2::XML_SUCCESS ||
+      std::rename( tmpPath.c_str(), path.c_str() ) != 0 )
+  {
+    std::cerr << "WARNING: Failed to save entry index " << path << std::endl;
+    std::remove( tmpPath.c_str() );
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,97 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ENTRYINDEX_H
+#define ENTRYINDEX_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Persistent record of what entry sources found on disk
+ *
+ * Each directory is stored with its mtime, so a rescan only needs to
+ * read directories which have changed since the last scan.
+ */
+class EntryIndex
+{
+public:
+  struct File
+  {
+    std::string name;
+    long long mtime;
+    // Parsed from the file where the source needs it (.desktop files)
+    std::string title;
+    std::string command;
+    std::string image;
+    bool hidden;
+  };
+
+  struct Directory
+  {
+    long long mtime;
+    std::vector<std::string> subdirs;
+    std::vector<File> files;
+  };
+
+  /// Directories by path
+  typedef std::map<std::string, Directory> Directories;
+
+  EntryIndex();
+  ~EntryIndex();
+
+  bool load( const std::string& path );
+  bool save( const std::string& path ) const;
+
+  /// Directories for a source, keyed by EntrySource::key(), added if missing
+  Directories& source( const std::string& key );
+  /// Directories for a source, nullptr if it isn't indexed
+  const Directories* findSource( const std::string& key ) const;
+  bool hasSource( const std::string& key ) const;
+
+  /**
+   * Drop sources which aren't configured any more
+   * @return true if any were dropped
+   */
+  bool retainSources( const std::set<std::string>& keys );
+
+  /**
+   * Default location, under $XDG_CACHE_HOME
+   * Each config file gets its own index, so they don't drop each other's sources
+   */
+  static std::string defaultPath( const std::string& configFile );
+
+private:
+  std::map<std::string, Directories> m_sources;
+};
+
+#endif
@@ -0,0 +1,162 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "entryscanner.h"
+
+#include <osg/Timer>
+#include <osgDB/ReadFile>
+
+#include <iostream>
+#include <set>
+
+EntryScanner::EntryScanner( const std::string& indexPath )
+  : m_indexPath( indexPath )
+  , m_resultsChanged{ false }
+{
+
+}
+
+EntryScanner::~EntryScanner()
+{
+  if( m_thread.joinable() )
+  {
+    m_thread.join();
+  }
+}
+
+size_t EntryScanner::addSource( std::shared_ptr<EntrySource> source )
+{
+  m_sources.push_back( source );
+  return m_sources.size() - 1;
+}
+
+bool EntryScanner::load()
+{
+  if( !m_indexPath.empty() )
+  {
+    m_index.load( m_indexPath );
+  }
+
+  bool complete{ true };
+  for( auto& source : m_sources )
+  {
+    complete = complete && m_index.hasSource( source->key() );
+  }
+  // Everything is loaded at startup anyway, before the first frame
+  publish( false );
+  return complete;
+}
+
+void EntryScanner::scan()
+{
+  auto startTick = osg::Timer::instance()->tick();
+  std::set<std::string> keys;
+  for( auto& source : m_sources )
+  {
+    keys.insert( source->key() );
+  }
+  // Keys change along with the config, don't keep old ones around forever
+  bool changed{ m_index.retainSources( keys ) };
+  for( auto& source : m_sources )
+  {
+    // Sources not in the index yet count as changed, even if they're empty
+    bool indexed{ m_index.hasSource( source->key() ) };
+    changed = source->scan( m_index.source( source->key() ) ) || !indexed || changed;
+  }
+  if( !changed )
+  {
+    return;
+  }
+
+  std::cerr << "Info: Entry sources rescanned in "
+            << osg::Timer::instance()->delta_m( startTick, osg::Timer::instance()->tick() ) << "ms" << std::endl;
+  if( !m_indexPath.empty() )
+  {
+    m_index.save( m_indexPath );
+  }
+  publish( true );
+}
+
+void EntryScanner::startScan()
+{
+  if( m_thread.joinable() )
+  {
+    return;
+  }
+  m_thread = std::thread( &EntryScanner::scan, this );
+}
+
+void EntryScanner::publish( bool preload )
+{
+  Results results;
+  for( auto& source : m_sources )
+  {
+    // Not source(), that would add the source and it would no longer count as unscanned
+    auto directories = m_index.findSource( source->key() );
+    results.push_back( directories ? source->entries( *directories ) : std::vector<EntrySource::Entry>() );
+  }
+
+  Images images;
+  std::set<std::string> imagePaths;
+  for( auto& sourceEntries : results )
+  {
+    for( auto& entry : sourceEntries )
+    {
+      if( entry.image.empty() ) continue;
+      imagePaths.insert( entry.image );
+      if( preload && m_publishedImages.find( entry.image ) == m_publishedImages.end() )
+      {
+        images[entry.image] = osgDB::readImageFile( entry.image );
+      }
+    }
+  }
+  m_publishedImages.swap( imagePaths );
+
+  std::lock_guard<std::mutex> lock( m_resultsMutex );
+  m_results.swap( results );
+  // Kept until taken, in case scans finish faster than the render loop takes them
+  for( auto& image : images ) m_images[image.first] = image.second;
+  m_resultsChanged = true;
+}
+
+bool EntryScanner::takeResults( Results& results, Images& images )
+{
+  if( !m_resultsChanged )
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock( m_resultsMutex );
+  results = m_results;
+  images.clear();
+  images.swap( m_images );
+  m_resultsChanged = false;
+  return true;
+}
@@ -0,0 +1,116 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ENTRYSCANNER_H
+#define ENTRYSCANNER_H
+
+#include "entryindex.h"
+#include "entrysource.h"
+
+#include <osg/Image>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs entry sources against the persistent index
+ *
+ * Entries are available straight away from the index, while a rescan
+ * runs in the background and picks up anything which has changed.
+ * Images for entries found by a rescan are loaded on the scanning thread,
+ * so adding them doesn't stall the render loop.
+ */
+class EntryScanner
+{
+public:
+  /// Entries for each source, in the order the sources were added
+  typedef std::vector< std::vector<EntrySource::Entry> > Results;
+  /// Preloaded images, by path
+  typedef std::map< std::string, osg::ref_ptr<osg::Image> > Images;
+
+  EntryScanner( const std::string& indexPath );
+  ~EntryScanner();
+
+  /// Returns the source's position in the Results
+  size_t addSource( std::shared_ptr<EntrySource> source );
+  bool empty() const;
+
+  /**
+   * Load the index from disk
+   * @return false if any source isn't in the index yet, and needs a scan
+   */
+  bool load();
+
+  /// Scan now, on the calling thread
+  void scan();
+  /// Scan on a background thread
+  void startScan();
+
+  /**
+   * Fetch the latest entries, called from the render loop
+   * @param images Receives images loaded for new entries since the last call
+   * @return false if nothing has changed since the last call
+   */
+  bool takeResults( Results& results, Images& images );
+
+private:
+  EntryScanner( const EntryScanner& ) = delete;
+  EntryScanner& operator=( const EntryScanner& ) = delete;
+
+  /// @param preload Load images which weren't in the previous results
+  void publish( bool preload );
+
+  std::string m_indexPath;
+  std::vector< std::shared_ptr<EntrySource> > m_sources;
+  // Only touched by whichever thread is scanning
+  EntryIndex m_index;
+  std::thread m_thread;
+
+  /// Image paths in the last results, only touched by the scanning thread
+  std::set<std::string> m_publishedImages;
+
+  std::mutex m_resultsMutex;
+  Results m_results;
+  Images m_images;
+  std::atomic<bool> m_resultsChanged;
+};
+
+inline bool EntryScanner::empty() const
+{
+  return m_sources.empty();
+}
+
+#endif
@@ -0,0 +1,440 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "entrysource.h"
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+  long long mtimeOf( const struct stat& st )
+  {
+    return static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+  }
+
+  bool isFile( const std::string& path )
+  {
+    struct stat st;
+    return stat( path.c_str(), &st ) == 0 && S_ISREG(st.st_mode);
+  }
+
+  std::string directoryOf( const std::string& path )
+  {
+    auto lastSlash = path.find_last_of('/');
+    return lastSlash == std::string::npos ? "." : path.substr(0, lastSlash);
+  }
+
+  /// Relative paths are relative to baseDir
+  std::string resolvePath( const std::string& path, const std::string& baseDir )
+  {
+    if( path.empty() || path[0] == '/' ) return path;
+    return baseDir + "/" + path;
+  }
+
+  std::string elementText( const tinyxml2::XMLElement* parent, const char* name )
+  {
+    const tinyxml2::XMLElement* element{ parent->FirstChildElement(name) };
+    const char* text{ element ? element->GetText() : nullptr };
+    return text ? text : "";
+  }
+
+  /// $XDG_DATA_HOME followed by $XDG_DATA_DIRS, in priority order
+  std::vector<std::string> xdgDataDirs()
+  {
+    std::vector<std::string> dirs;
+    const char* dataHome{ std::getenv("XDG_DATA_HOME") };
+    const char* home{ std::getenv("HOME") };
+    if( dataHome && *dataHome ) dirs.push_back( dataHome );
+    else if( home && *home ) dirs.push_back( std::string(home) + "/.local/share" );
+
+    const char* dataDirs{ std::getenv("XDG_DATA_DIRS") };
+    std::string dataDirsStr( dataDirs && *dataDirs ? dataDirs : "/usr/local/share:/usr/share" );
+    size_t start{ 0 };
+    while( start <= dataDirsStr.size() )
+    {
+      auto end = dataDirsStr.find(':', start);
+      if( end == std::string::npos ) end = dataDirsStr.size();
+      if( end > start ) dirs.push_back( dataDirsStr.substr(start, end - start) );
+      start = end + 1;
+    }
+    return dirs;
+  }
+
+  /// Icon theme lookup, only the hicolor fallback theme and PNGs
+  std::string findIcon( const std::string& icon )
+  {
+    if( icon.empty() ) return "";
+    if( icon[0] == '/' ) return isFile(icon) ? icon : "";
+
+    const char* sizes[] = { "512x512", "256x256", "128x128", "96x96", "64x64", "48x48" };
+    for( auto& dataDir : xdgDataDirs() )
+    {
+      for( auto size : sizes )
+      {
+        std::string path( dataDir + "/icons/hicolor/" + size + "/apps/" + icon + ".png" );
+        if( isFile(path) ) return path;
+      }
+    }
+    std::string pixmap( "/usr/share/pixmaps/" + icon + ".png" );
+    return isFile(pixmap) ? pixmap : "";
+  }
+
+  std::string shellQuote( const std::string& str )
+  {
+    std::string quoted( "'" );
+    for( auto c : str )
+    {
+      if( c == '\'' ) quoted += "'\\''";
+      else quoted += c;
+    }
+    return quoted + "'";
+  }
+
+  /// Strip the field codes from a desktop entry Exec key
+  std::string execCommand( const std::string& exec, const std::string& name )
+  {
+    std::string command;
+    for( size_t i = 0; i < exec.size(); ++i )
+    {
+      if( exec[i] != '%' || i + 1 == exec.size() )
+      {
+        command += exec[i];
+        continue;
+      }
+      ++i;
+      if( exec[i] == '%' ) command += '%';
+      else if( exec[i] == 'c' ) command += shellQuote( name );
+      else if( i + 1 < exec.size() && exec[i + 1] == ' ' && !command.empty() && command.back() == ' ' )
+      {
+        // Files, urls and icons are never passed, drop the code and its separator
+        ++i;
+      }
+    }
+    // Trailing space left by a dropped code
+    while( !command.empty() && command.back() == ' ' ) command.pop_back();
+    return command;
+  }
+
+  void parseDesktopFile( const std::string& path, EntryIndex::File& file )
+  {
+    file.title.clear();
+    file.command.clear();
+    file.image.clear();
+    file.hidden = true;
+
+    std::ifstream stream( path );
+    std::string line;
+    bool inEntry{ false };
+    bool application{ false };
+    bool noDisplay{ false };
+    std::string icon;
+    while( std::getline(stream, line) )
+    {
+      if( line.empty() || line[0] == '#' ) continue;
+      if( line[0] == '[' )
+      {
+        inEntry = line.compare(0, 15, "[Desktop Entry]") == 0;
+        continue;
+      }
+      if( !inEntry ) continue;
+
+      auto equals = line.find('=');
+      if( equals == std::string::npos ) continue;
+      std::string key( line.substr(0, equals) );
+      std::string value( line.substr(equals + 1) );
+      while( !key.empty() && key.back() == ' ' ) key.pop_back();
+      while( !value.empty() && value[0] == ' ' ) value.erase(0, 1);
+
+      if( key == "Type" ) application = value == "Application";
+      else if( key == "Name" ) file.title = value;
+      else if( key == "Exec" ) file.command = value;
+      else if( key == "Icon" ) icon = value;
+      else if( key == "NoDisplay" || key == "Hidden" ) noDisplay = noDisplay || value == "true";
+    }
+
+    file.hidden = !application || noDisplay || file.command.empty();
+    if( !file.hidden )
+    {
+      file.command = execCommand( file.command, file.title );
+      file.image = findIcon( icon );
+    }
+  }
+
+  /// Replace %f, %n and %d in a directory source template
+  std::string substitute( const std::string& str, const std::string& path, bool quote )
+  {
+    auto dir = directoryOf( path );
+    auto fileName = path.substr( path.find_last_of('/') + 1 );
+    auto name = fileName.substr( 0, fileName.find_last_of('.') );
+
+    std::string result;
+    for( size_t i = 0; i < str.size(); ++i )
+    {
+      if( str[i] != '%' || i + 1 == str.size() )
+      {
+        result += str[i];
+        continue;
+      }
+      switch( str[++i] )
+      {
+        case 'f': result += quote ? shellQuote(path) : path; break;
+        case 'n': result += quote ? shellQuote(name) : name; break;
+        case 'd': result += quote ? shellQuote(dir) : dir; break;
+        case '%': result += '%'; break;
+        default: result += '%'; result += str[i]; break;
+      }
+    }
+    return result;
+  }
+}
+
+EntrySource::EntrySource( const tinyxml2::XMLElement* xmlSource, std::string xmlFile )
+  : m_type{ Type::Directory }
+  , m_valid{ false }
+  , m_recursive{ false }
+{
+  auto configDir = directoryOf( xmlFile );
+  const char* type{ xmlSource->Attribute("type") };
+
+  for( auto xmlPath = xmlSource->FirstChildElement("path"); xmlPath; xmlPath = xmlPath->NextSiblingElement("path") )
+  {
+    if( xmlPath->GetText() ) m_paths.push_back( resolvePath(xmlPath->GetText(), configDir) );
+  }
+
+  if( type && std::strcmp(type, "directory") == 0 )
+  {
+    m_type = Type::Directory;
+    m_glob = elementText( xmlSource, "glob" );
+    if( m_glob.empty() ) m_glob = "*";
+    m_recursive = elementText( xmlSource, "recursive" ) == "true";
+    m_command = elementText( xmlSource, "command" );
+    m_image = elementText( xmlSource, "image" );
+    if( m_paths.empty() || m_command.empty() )
+    {
+      std::cerr << "Error: Directory <source> needs a <path> and a <command>" << std::endl;
+      return;
+    }
+  }
+  else if( type && std::strcmp(type, "desktop") == 0 )
+  {
+    m_type = Type::Desktop;
+    m_glob = "*.desktop";
+    m_recursive = true;
+    if( m_paths.empty() )
+    {
+      for( auto& dataDir : xdgDataDirs() ) m_paths.push_back( dataDir + "/applications" );
+    }
+  }
+  else
+  {
+    std::cerr << "Error: Unknown <source> type: " << (type ? type : "") << std::endl;
+    return;
+  }
+
+  m_key = std::string(type) + ":" + m_glob + (m_recursive ? ":r" : "");
+  for( auto& path : m_paths ) m_key += ":" + path;
+  m_valid = true;
+}
+
+EntrySource::~EntrySource()
+{
+
+}
+
+bool EntrySource::matches( const std::string& fileName ) const
+{
+  return fnmatch( m_glob.c_str(), fileName.c_str(), 0 ) == 0;
+}
+
+bool EntrySource::scan( EntryIndex::Directories& directories ) const
+{
+  EntryIndex::Directories updated;
+  std::set<std::pair<unsigned long long, unsigned long long>> visited;
+  bool changed{ false };
+  for( auto& path : m_paths )
+  {
+    scanDirectory( path, directories, updated, visited, changed );
+  }
+  // Directories which have gone away
+  changed = changed || updated.size() != directories.size();
+  directories.swap( updated );
+  return changed;
+}
+
+void EntrySource::scanDirectory( const std::string& path, const EntryIndex::Directories& previous,
+                                 EntryIndex::Directories& updated,
+                                 std::set<std::pair<unsigned long long, unsigned long long>>& visited,
+                                 bool& changed ) const
+{
+  struct stat st;
+  if( stat( path.c_str(), &st ) != 0 || !S_ISDIR(st.st_mode) )
+  {
+    return;
+  }
+
+  // Paths differ each time round a symlink loop, so compare the directories themselves
+  if( !visited.insert( std::make_pair( static_cast<unsigned long long>(st.st_dev),
+                                       static_cast<unsigned long long>(st.st_ino) ) ).second )
+  {
+    return;
+  }
+
+  auto previousDir = previous.find( path );
+  auto& dir = updated[path];
+  if( previousDir != previous.end() && previousDir->second.mtime == mtimeOf(st) )
+  {
+    // Nothing added, removed or renamed here
+    dir = previousDir->second;
+  }
+  else
+  {
+    changed = true;
+    dir.mtime = mtimeOf(st);
+    readDirectory( path, previousDir != previous.end() ? &previousDir->second : nullptr, dir );
+  }
+
+  if( m_recursive )
+  {
+    // Subdirectories still need a stat, a change further down doesn't touch our mtime
+    auto subdirs = dir.subdirs;
+    for( auto& subdir : subdirs )
+    {
+      scanDirectory( path + "/" + subdir, previous, updated, visited, changed );
+    }
+  }
+}
+
+void EntrySource::readDirectory( const std::string& path, const EntryIndex::Directory* previous,
+                                 EntryIndex::Directory& dir ) const
+{
+  DIR* handle{ opendir( path.c_str() ) };
+  if( handle == nullptr )
+  {
+    std::cerr << "WARNING: Failed to read " << path << std::endl;
+    return;
+  }
+
+  while( dirent* ent = readdir( handle ) )
+  {
+    std::string name( ent->d_name );
+    if( name == "." || name == ".." ) continue;
+
+    std::string filePath( path + "/" + name );
+    struct stat st;
+    if( stat( filePath.c_str(), &st ) != 0 ) continue;
+
+    if( S_ISDIR(st.st_mode) )
+    {
+      if( m_recursive ) dir.subdirs.push_back( name );
+      continue;
+    }
+    if( !S_ISREG(st.st_mode) || !matches(name) ) continue;
+
+    EntryIndex::File file;
+    file.name = name;
+    file.mtime = mtimeOf(st);
+    file.hidden = false;
+
+    // Only parse files which have changed
+    const EntryIndex::File* previousFile{ nullptr };
+    if( previous )
+    {
+      auto it = std::find_if( previous->files.begin(), previous->files.end(),
+                              [&name]( const EntryIndex::File& f ) { return f.name == name; } );
+      if( it != previous->files.end() && it->mtime == file.mtime ) previousFile = &(*it);
+    }
+    if( previousFile ) file = *previousFile;
+    else if( m_type == Type::Desktop ) parseDesktopFile( filePath, file );
+
+    dir.files.push_back( file );
+  }
+  closedir( handle );
+
+  std::sort( dir.subdirs.begin(), dir.subdirs.end() );
+  std::sort( dir.files.begin(), dir.files.end(),
+             []( const EntryIndex::File& a, const EntryIndex::File& b ) { return a.name < b.name; } );
+}
+
+std::vector<EntrySource::Entry> EntrySource::entries( const EntryIndex::Directories& directories ) const
+{
+  std::vector<Entry> entries;
+  std::set<std::string> ids;
+  for( auto& path : m_paths )
+  {
+    listEntries( path, "", directories, entries, ids );
+  }
+  return entries;
+}
+
+void EntrySource::listEntries( const std::string& path, const std::string& idPrefix,
+                               const EntryIndex::Directories& directories,
+                               std::vector<Entry>& entries, std::set<std::string>& ids ) const
+{
+  auto it = directories.find( path );
+  if( it == directories.end() ) return;
+  auto& dir = it->second;
+
+  for( auto& file : dir.files )
+  {
+    // Desktop file ids are relative paths with '/' as '-', earlier directories take priority,
+    // including hiding an application
+    if( m_type == Type::Desktop && !ids.insert( idPrefix + file.name ).second ) continue;
+    if( file.hidden ) continue;
+
+    auto filePath = path + "/" + file.name;
+    Entry entry;
+    if( m_type == Type::Desktop )
+    {
+      entry.name = file.title;
+      entry.command = file.command;
+      entry.image = file.image;
+    }
+    else
+    {
+      entry.name = file.name.substr( 0, file.name.find_last_of('.') );
+      entry.command = substitute( m_command, filePath, true );
+      entry.image = resolvePath( substitute(m_image, filePath, false), path );
+    }
+    entries.push_back( entry );
+  }
+
+  for( auto& subdir : dir.subdirs )
+  {
+    listEntries( path + "/" + subdir, idPrefix + subdir + "-", directories, entries, ids );
+  }
+}
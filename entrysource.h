@@ -0,0 +1,119 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ENTRYSOURCE_H
+#define ENTRYSOURCE_H
+
+#include "entryindex.h"
+
+#include <tinyxml2.h>
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Menu entries generated from the filesystem, from a <source> element
+ *
+ * - type="directory": One entry per file matching <glob> under each <path>.
+ *   <command> and <image> may contain %f (full path, shell quoted for commands),
+ *   %n (file name without extension) and %d (directory). Relative images are
+ *   relative to the matched file.
+ * - type="desktop": One entry per XDG .desktop application. Without a <path>
+ *   the standard XDG applications directories are used.
+ */
+class EntrySource
+{
+public:
+  struct Entry
+  {
+    std::string name;
+    std::string image;
+    std::string command;
+  };
+
+  EntrySource( const tinyxml2::XMLElement* xmlSource, std::string xmlFile );
+  ~EntrySource();
+
+  bool valid() const;
+
+  /// Identifies the source in the index
+  const std::string& key() const;
+
+  /**
+   * Bring the indexed directories up to date
+   * Only directories whose mtime has changed are read
+   * @return true if anything changed
+   */
+  bool scan( EntryIndex::Directories& directories ) const;
+
+  /// Entries for the indexed directories, no filesystem access
+  std::vector<Entry> entries( const EntryIndex::Directories& directories ) const;
+
+private:
+  enum class Type
+  {
+    Directory,
+    Desktop,
+  };
+
+  void scanDirectory( const std::string& path, const EntryIndex::Directories& previous,
+                      EntryIndex::Directories& updated,
+                      std::set<std::pair<unsigned long long, unsigned long long>>& visited,
+                      bool& changed ) const;
+  void readDirectory( const std::string& path, const EntryIndex::Directory* previous,
+                      EntryIndex::Directory& dir ) const;
+  void listEntries( const std::string& path, const std::string& idPrefix,
+                    const EntryIndex::Directories& directories,
+                    std::vector<Entry>& entries, std::set<std::string>& ids ) const;
+  bool matches( const std::string& fileName ) const;
+
+  Type m_type;
+  bool m_valid;
+  std::vector<std::string> m_paths;
+  std::string m_glob;
+  bool m_recursive;
+  std::string m_command;
+  std::string m_image;
+  std::string m_key;
+};
+
+inline bool EntrySource::valid() const
+{
+  return m_valid;
+}
+
+inline const std::string& EntrySource::key() const
+{
+  return m_key;
+}
+
+#endif
@@ -0,0 +1,463 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "evdevinput.h"
+
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+// Older kernel headers only have the timeval member
+#ifndef input_event_sec
+# define input_event_sec time.tv_sec
+# define input_event_usec time.tv_usec
+#endif
+
+namespace
+{
+  // Matches typical keyboard auto-repeat
+  const double repeatDelay{ 0.4 };
+  const double repeatInterval{ 0.1 };
+
+  osg::Timer_t ticksFromSeconds( double s )
+  {
+    return static_cast<osg::Timer_t>( s / osg::Timer::instance()->getSecondsPerTick() );
+  }
+}
+
+EvdevInput::EvdevInput()
+  : m_queue( 256 )
+  , m_running{ false }
+  , m_epollFd{ -1 }
+  , m_wakeFd{ -1 }
+  , m_held{ false }
+  , m_heldAction{ Action::Left }
+  , m_heldDevice{ nullptr }
+  , m_heldType{ 0 }
+  , m_heldCode{ 0 }
+  , m_nextRepeat{ 0 }
+{
+
+}
+
+EvdevInput::~EvdevInput()
+{
+  stop();
+  for( auto& device : m_devices )
+  {
+    close( device.fd );
+  }
+  if( m_wakeFd >= 0 ) close( m_wakeFd );
+  if( m_epollFd >= 0 ) close( m_epollFd );
+}
+
+unsigned int EvdevInput::addDevices( const std::string& pattern, int axisMin, int axisMax )
+{
+  // The input thread holds pointers into m_devices
+  if( m_running )
+  {
+    return 0;
+  }
+
+  glob_t matches;
+  if( glob( pattern.c_str(), 0, nullptr, &matches ) != 0 )
+  {
+    std::cerr << "WARNING: No input devices match " << pattern << std::endl;
+    return 0;
+  }
+
+  unsigned int opened{ 0 };
+  for( size_t i = 0; i < matches.gl_pathc; ++i )
+  {
+    std::string path( matches.gl_pathv[i] );
+    int fd{ open( path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC ) };
+    if( fd < 0 )
+    {
+      std::cerr << "WARNING: Failed to open input device " << path << ": " << strerror(errno) << std::endl;
+      continue;
+    }
+
+    Device device;
+    device.fd = fd;
+    device.path = path;
+    device.xMin = axisMin;
+    device.xMax = axisMax;
+    device.xDirection = 0;
+    device.hatDirection = 0;
+    device.lost = false;
+    device.hasPending = false;
+    device.firstTime = -1.0;
+    device.startTick = 0;
+    device.pendingDue = 0;
+
+    struct stat st;
+    device.recording = fstat( fd, &st ) == 0 && S_ISREG(st.st_mode);
+    if( device.recording )
+    {
+      // Replayed from the input thread's loop, reading a file never waits
+      fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) & ~O_NONBLOCK );
+      device.monotonic = false;
+      if( device.xMax <= device.xMin )
+      {
+        std::cerr << "WARNING: Invalid axis range for " << path << ", using the default" << std::endl;
+        device.xMin = defaultAxisMin;
+        device.xMax = defaultAxisMax;
+      }
+    }
+    else
+    {
+      int clock{ CLOCK_MONOTONIC };
+      device.monotonic = ioctl( fd, EVIOCSCLOCKID, &clock ) == 0;
+
+      input_absinfo absInfo;
+      if( ioctl( fd, EVIOCGABS(ABS_X), &absInfo ) == 0 && absInfo.maximum > absInfo.minimum )
+      {
+        device.xMin = absInfo.minimum;
+        device.xMax = absInfo.maximum;
+      }
+    }
+
+    m_devices.push_back( device );
+    ++opened;
+  }
+  globfree( &matches );
+  return opened;
+}
+
+bool EvdevInput::start()
+{
+  if( m_running || m_devices.empty() )
+  {
+    return false;
+  }
+
+  m_epollFd = epoll_create1( EPOLL_CLOEXEC );
+  m_wakeFd = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+  if( m_epollFd < 0 || m_wakeFd < 0 )
+  {
+    std::cerr << "ERROR: Failed to initialise input thread: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.ptr = nullptr;
+  epoll_ctl( m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev );
+
+  for( auto& device : m_devices )
+  {
+    if( device.recording ) continue;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &device;
+    if( epoll_ctl( m_epollFd, EPOLL_CTL_ADD, device.fd, &ev ) != 0 )
+    {
+      std::cerr << "WARNING: Failed to watch input device " << device.path << ": " << strerror(errno) << std::endl;
+    }
+  }
+
+  m_running = true;
+  m_thread = std::thread( &EvdevInput::run, this );
+  return true;
+}
+
+void EvdevInput::stop()
+{
+  if( !m_running )
+  {
+    return;
+  }
+  m_running = false;
+  uint64_t one{ 1 };
+  if( write( m_wakeFd, &one, sizeof(one) ) != sizeof(one) )
+  {
+    std::cerr << "WARNING: Failed to wake input thread" << std::endl;
+  }
+  m_thread.join();
+}
+
+bool EvdevInput::poll( Event& event )
+{
+  return m_queue.pop( event );
+}
+
+void EvdevInput::run()
+{
+  auto timer = osg::Timer::instance();
+  auto startTick = timer->tick();
+  for( auto& device : m_devices )
+  {
+    if( !device.recording ) continue;
+    device.startTick = startTick;
+    if( !nextRecorded( device ) ) deviceLost( device );
+  }
+
+  epoll_event events[16];
+  while( m_running )
+  {
+    // Replay first, so a recorded press is repeating before we sleep
+    for( auto& device : m_devices )
+    {
+      if( device.recording && !device.lost ) replay( device );
+    }
+
+    // Sleep until the next repeat or recorded event, whichever is first
+    bool waiting{ m_held };
+    osg::Timer_t wake{ m_nextRepeat };
+    for( auto& device : m_devices )
+    {
+      if( !device.recording || device.lost ) continue;
+      wake = waiting ? std::min( wake, device.pendingDue ) : device.pendingDue;
+      waiting = true;
+    }
+
+    int timeoutMs{ -1 };
+    if( waiting )
+    {
+      auto now = timer->tick();
+      timeoutMs = now >= wake ? 0 : static_cast<int>( 1e3 * timer->delta_s( now, wake ) ) + 1;
+    }
+
+    int numEvents{ epoll_wait( m_epollFd, events, 16, timeoutMs ) };
+    if( numEvents < 0 )
+    {
+      if( errno == EINTR ) continue;
+      std::cerr << "ERROR: Input thread failed: " << strerror(errno) << std::endl;
+      break;
+    }
+
+    for( int i = 0; i < numEvents; ++i )
+    {
+      auto device = static_cast<Device*>( events[i].data.ptr );
+      if( device == nullptr ) continue; // Woken by stop()
+      if( !readDevice( *device ) )
+      {
+        // Most likely unplugged, stop watching it
+        epoll_ctl( m_epollFd, EPOLL_CTL_DEL, device->fd, nullptr );
+        deviceLost( *device );
+      }
+    }
+
+    repeatHeld();
+  }
+}
+
+bool EvdevInput::nextRecorded( Device& device )
+{
+  if( read( device.fd, &device.pending, sizeof(device.pending) ) != sizeof(device.pending) )
+  {
+    device.hasPending = false;
+    return false;
+  }
+
+  double time{ device.pending.input_event_sec + device.pending.input_event_usec * 1e-6 };
+  if( device.firstTime < 0.0 )
+  {
+    device.firstTime = time;
+  }
+  device.hasPending = true;
+  device.pendingDue = device.startTick + ticksFromSeconds( std::max( time - device.firstTime, 0.0 ) );
+  return true;
+}
+
+void EvdevInput::replay( Device& device )
+{
+  auto now = osg::Timer::instance()->tick();
+  while( device.hasPending && device.pendingDue <= now )
+  {
+    handleEvent( device, device.pending, now );
+    if( !nextRecorded( device ) )
+    {
+      // A recording that ends mid-press mustn't leave it held
+      deviceLost( device );
+    }
+  }
+}
+
+bool EvdevInput::readDevice( Device& device )
+{
+  auto timer = osg::Timer::instance();
+  input_event buffer[64];
+  while( true )
+  {
+    auto bytes = read( device.fd, buffer, sizeof(buffer) );
+    if( bytes < 0 )
+    {
+      if( errno == EAGAIN || errno == EINTR ) return true;
+      std::cerr << "WARNING: Lost input device " << device.path << ": " << strerror(errno) << std::endl;
+      return false;
+    }
+    if( bytes == 0 ) return false;
+
+    auto readTick = timer->tick();
+    timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    for( size_t i = 0; i < static_cast<size_t>(bytes) / sizeof(input_event); ++i )
+    {
+      auto tick = readTick;
+      if( device.monotonic )
+      {
+        // Backdate to when the kernel saw the input
+        double age{ (now.tv_sec - buffer[i].input_event_sec) + (now.tv_nsec / 1e9 - buffer[i].input_event_usec / 1e6) };
+        if( age > 0.0 ) tick -= std::min( tick, ticksFromSeconds( age ) );
+      }
+      handleEvent( device, buffer[i], tick );
+    }
+  }
+}
+
+void EvdevInput::deviceLost( Device& device )
+{
+  device.lost = true;
+  clearHeld( device );
+}
+
+void EvdevInput::handleEvent( Device& device, const input_event& ev, osg::Timer_t tick )
+{
+  if( ev.type == EV_SYN && ev.code == SYN_DROPPED )
+  {
+    // The kernel's buffer overflowed, any release may have been lost
+    clearHeld( device );
+  }
+  else if( ev.type == EV_KEY )
+  {
+    // Ignore the kernel's key repeat (value 2), we repeat gamepads too so do it ourselves
+    if( ev.value == 2 ) return;
+
+    Action action;
+    switch( ev.code )
+    {
+      case KEY_LEFT:
+      case BTN_DPAD_LEFT:
+        action = Action::Left;
+        break;
+      case KEY_RIGHT:
+      case BTN_DPAD_RIGHT:
+        action = Action::Right;
+        break;
+      case KEY_ENTER:
+      case KEY_KPENTER:
+      case KEY_OK:
+      case KEY_SELECT:
+      case BTN_SOUTH:
+      case BTN_START:
+        action = Action::Select;
+        break;
+      default:
+        return;
+    }
+    if( ev.value ) press( device, ev.type, ev.code, action, tick );
+    else release( device, ev.type, ev.code, action );
+  }
+  else if( ev.type == EV_ABS )
+  {
+    switch( ev.code )
+    {
+      case ABS_HAT0X:
+        axisChanged( device, ev.code, device.hatDirection, ev.value < 0 ? -1 : ev.value > 0 ? 1 : 0, tick );
+        break;
+      case ABS_X:
+      {
+        // Stick needs to be pushed over halfway
+        int centre{ device.xMin + (device.xMax - device.xMin) / 2 };
+        int threshold{ (device.xMax - device.xMin) / 4 };
+        int direction{ ev.value < centre - threshold ? -1 : ev.value > centre + threshold ? 1 : 0 };
+        axisChanged( device, ev.code, device.xDirection, direction, tick );
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+void EvdevInput::axisChanged( Device& device, unsigned short code, int& direction, int newDirection, osg::Timer_t tick )
+{
+  if( newDirection == direction ) return;
+  if( direction != 0 ) release( device, EV_ABS, code, direction < 0 ? Action::Left : Action::Right );
+  if( newDirection != 0 ) press( device, EV_ABS, code, newDirection < 0 ? Action::Left : Action::Right, tick );
+  direction = newDirection;
+}
+
+void EvdevInput::press( Device& device, unsigned short type, unsigned short code, Action action, osg::Timer_t tick )
+{
+  emit( action, tick );
+  if( action == Action::Select ) return;
+  m_held = true;
+  m_heldAction = action;
+  m_heldDevice = &device;
+  m_heldType = type;
+  m_heldCode = code;
+  m_nextRepeat = osg::Timer::instance()->tick() + ticksFromSeconds( repeatDelay );
+}
+
+void EvdevInput::release( const Device& device, unsigned short type, unsigned short code, Action action )
+{
+  // Only the control that started the hold can end it, not another pad or key
+  if( m_held && m_heldDevice == &device && m_heldType == type &&
+      m_heldCode == code && m_heldAction == action ) m_held = false;
+}
+
+void EvdevInput::clearHeld( Device& device )
+{
+  device.xDirection = 0;
+  device.hatDirection = 0;
+  if( m_heldDevice == &device ) m_held = false;
+}
+
+void EvdevInput::repeatHeld()
+{
+  auto now = osg::Timer::instance()->tick();
+  if( m_held && now >= m_nextRepeat )
+  {
+    emit( m_heldAction, now );
+    m_nextRepeat += ticksFromSeconds( repeatInterval );
+  }
+}
+
+void EvdevInput::emit( Action action, osg::Timer_t tick )
+{
+  Event event;
+  event.action = action;
+  event.tick = tick;
+  // Dropped if the render loop is blocked, e.g. while running a command
+  m_queue.push( event );
+}
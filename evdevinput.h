@@ -0,0 +1,156 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef EVDEVINPUT_H
+#define EVDEVINPUT_H
+
+#include "spscqueue.h"
+
+#include <osg/Timer>
+
+#include <linux/input.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Reads gamepads, remotes and other evdev devices on a dedicated thread
+ *
+ * Buttons and axes are mapped to navigation actions and passed to the render loop
+ * through a lock-free queue, independent of the windowing system and window focus.
+ * Held directions auto-repeat, as keyboards do.
+ *
+ * Regular files are treated as recordings of a device (raw struct input_event,
+ * e.g. from cat /dev/input/eventN > recording) and replayed with their original
+ * timing, so input can be tested without hardware. Recordings don't carry the
+ * stick's range, so it can be given when adding them. Devices created through
+ * uinput can be read as normal.
+ */
+class EvdevInput
+{
+public:
+  enum class Action
+  {
+    Left,
+    Right,
+    Select,
+  };
+
+  struct Event
+  {
+    Action action;
+    /// osg::Timer tick when the input happened
+    osg::Timer_t tick;
+  };
+
+  EvdevInput();
+  ~EvdevInput();
+
+  /// Stick range assumed for recordings, the usual range for gamepads
+  static const int defaultAxisMin{ -32768 };
+  static const int defaultAxisMax{ 32767 };
+
+  /**
+   * Open devices matching a glob pattern, e.g. /dev/input/event*
+   * @param axisMin, axisMax Stick range for recordings, devices report their own
+   * @return The number of devices opened
+   */
+  unsigned int addDevices( const std::string& pattern,
+                           int axisMin = defaultAxisMin, int axisMax = defaultAxisMax );
+
+  bool start();
+  void stop();
+
+  /// Called from the render loop. Returns false when no actions are waiting
+  bool poll( Event& event );
+
+private:
+  struct Device
+  {
+    int fd;
+    std::string path;
+    bool recording;
+    /// Input timestamps are CLOCK_MONOTONIC, and can be used for latency
+    bool monotonic;
+    int xMin;
+    int xMax;
+    int xDirection;
+    int hatDirection;
+    /// No longer read, unplugged or end of recording
+    bool lost;
+
+    // Replay state for recordings
+    bool hasPending;
+    input_event pending;
+    /// Timestamp of the first event, negative until it's read
+    double firstTime;
+    osg::Timer_t startTick;
+    osg::Timer_t pendingDue;
+  };
+
+  EvdevInput( const EvdevInput& ) = delete;
+  EvdevInput& operator=( const EvdevInput& ) = delete;
+
+  void run();
+  /// Load the next event of a recording, returns false at the end
+  bool nextRecorded( Device& device );
+  /// Handle recorded events which are due
+  void replay( Device& device );
+  bool readDevice( Device& device );
+  void deviceLost( Device& device );
+  void handleEvent( Device& device, const input_event& ev, osg::Timer_t tick );
+  void axisChanged( Device& device, unsigned short code, int& direction, int newDirection, osg::Timer_t tick );
+  /// type and code are the evdev control, a key or an axis, which owns the hold
+  void press( Device& device, unsigned short type, unsigned short code, Action action, osg::Timer_t tick );
+  void release( const Device& device, unsigned short type, unsigned short code, Action action );
+  /// Forget what the device was holding, for when its releases may be lost
+  void clearHeld( Device& device );
+  void repeatHeld();
+  void emit( Action action, osg::Timer_t tick );
+
+  std::vector<Device> m_devices;
+  SPSCQueue<Event> m_queue;
+  std::thread m_thread;
+  std::atomic<bool> m_running;
+  int m_epollFd;
+  int m_wakeFd;
+
+  // Auto-repeat state, only touched by the input thread
+  bool m_held;
+  Action m_heldAction;
+  const Device* m_heldDevice;
+  unsigned short m_heldType;
+  unsigned short m_heldCode;
+  osg::Timer_t m_nextRepeat;
+};
+
+#endif
@@ -30,12 +30,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "inputhandler.h"
 
+#include <algorithm>
 #include <iostream>
 
 InputHandler::InputHandler( Main* main, std::shared_ptr< std::vector< std::shared_ptr<MenuEntry> > > entries )
   : m_main( main )
   , m_entries( entries )
   , m_currentIndex{ 0 }
+  , m_pendingSteps{ 0 }
 {
 
 }
@@ -45,6 +47,42 @@ InputHandler::~InputHandler()
 
 }
 
+void InputHandler::setCurrentIndex( unsigned int index )
+{
+  m_currentIndex = m_entries->empty() ? 0 : std::min( index, static_cast<unsigned int>( m_entries->size() - 1 ) );
+}
+
+bool InputHandler::applyPendingInput( std::vector<double>& eventTimes )
+{
+  eventTimes.swap( m_pendingEventTimes );
+  m_pendingEventTimes.clear();
+
+  if( m_pendingSteps == 0 )
+  {
+    return false;
+  }
+
+  // Clamp the whole jump at once rather than per key press
+  auto lastIndex = static_cast<int>( m_entries->size() ) - 1;
+  auto newIndex = static_cast<int>( m_currentIndex ) + m_pendingSteps;
+  newIndex = std::max( 0, std::min( newIndex, lastIndex ) );
+  m_pendingSteps = 0;
+
+  if( static_cast<unsigned int>( newIndex ) == m_currentIndex )
+  {
+    return false;
+  }
+  m_currentIndex = static_cast<unsigned int>( newIndex );
+  //std::cerr << "Info: Selected " << m_currentIndex + 1 << " of " << m_entries->size() << std::endl;
+  return true;
+}
+
+void InputHandler::step( int steps, double eventTime )
+{
+  m_pendingSteps += steps;
+  m_pendingEventTimes.push_back( eventTime );
+}
+
 bool InputHandler::handle( const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAdapter& )
 {
   switch( ea.getEventType() )
@@ -53,12 +91,10 @@ bool InputHandler::handle( const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAda
       switch( ea.getKey() )
       {
         case osgGA::GUIEventAdapter::KEY_Right:
-        if( m_currentIndex < m_entries->size() - 1 ) ++m_currentIndex;
-          //std::cerr << "Info: Selected " << m_currentIndex + 1 << " of " << m_entries->size() << std::endl;
+          step( 1, ea.getTime() );
           break;
         case osgGA::GUIEventAdapter::KEY_Left:
-        if( m_currentIndex > 0 ) --m_currentIndex;
-          //std::cerr << "Info: Selected " << m_currentIndex + 1 << " of " << m_entries->size() << std::endl;
+          step( -1, ea.getTime() );
           break;
         case osgGA::GUIEventAdapter::KEY_Return:
           m_main->enterPressed();
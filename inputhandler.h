@@ -37,7 +37,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <osgGA/GUIEventHandler>
 
 #include <memory>
+#include <vector>
 
+/**
+ * Collects navigation input from the event queue
+ *
+ * Key presses are coalesced rather than applied one at a time,
+ * so several presses within one frame become a single jump.
+ * The render loop applies them once per frame via applyPendingInput.
+ */
 class InputHandler : public osgGA::GUIEventHandler
 {
 public:
@@ -45,6 +53,22 @@ public:
   ~InputHandler();
 
   unsigned int currentIndex() const;
+  /// Select an entry directly, e.g. after the entries change
+  void setCurrentIndex( unsigned int index );
+
+  /**
+   * Apply all navigation received since the last call
+   * @param eventTimes Receives the event queue timestamps of the applied events
+   * @return true if the selection changed
+   */
+  bool applyPendingInput( std::vector<double>& eventTimes );
+
+  /**
+   * Queue navigation from a source other than the event queue
+   * @param steps Entries to move by, negative to move left
+   * @param eventTime Time of the input, in event queue time
+   */
+  void step( int steps, double eventTime );
 
   virtual bool handle( const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAdapter& aa ) final override;
 
@@ -52,6 +76,8 @@ private:
   Main* m_main;
   std::shared_ptr< std::vector< std::shared_ptr<MenuEntry> > > m_entries;
   unsigned int m_currentIndex;
+  int m_pendingSteps;
+  std::vector<double> m_pendingEventTimes;
 };
 
 inline unsigned int InputHandler::currentIndex() const
@@ -0,0 +1,114 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "latencyhistogram.h"
+
+#include <algorithm>
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram( const std::string& name, double bucketWidthMs, unsigned int numBuckets )
+  : m_name( name )
+  , m_bucketWidthMs{ bucketWidthMs }
+  , m_buckets( numBuckets, 0 )
+  , m_overflow{ 0 }
+  , m_count{ 0 }
+  , m_total{ 0.0 }
+  , m_max{ 0.0 }
+{
+
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+
+}
+
+void LatencyHistogram::add( double latencyMs )
+{
+  // Event timestamps can be very slightly ahead of the frame clock
+  latencyMs = std::max( latencyMs, 0.0 );
+
+  auto bucket = static_cast<size_t>( latencyMs / m_bucketWidthMs );
+  if( bucket < m_buckets.size() ) ++m_buckets[bucket];
+  else ++m_overflow;
+
+  ++m_count;
+  m_total += latencyMs;
+  m_max = std::max( m_max, latencyMs );
+}
+
+double LatencyHistogram::percentile( double p ) const
+{
+  if( m_count == 0 ) return 0.0;
+
+  // Report the upper edge of the bucket containing the percentile
+  auto target = static_cast<unsigned int>( (p / 100.0) * m_count + 0.5 );
+  target = std::max( target, 1u );
+  unsigned int seen{ 0 };
+  for( size_t i = 0; i < m_buckets.size(); ++i )
+  {
+    seen += m_buckets[i];
+    if( seen >= target ) return (i + 1) * m_bucketWidthMs;
+  }
+  return m_max;
+}
+
+void LatencyHistogram::report( std::ostream& stream ) const
+{
+  stream << "Info: Latency " << m_name << ": " << m_count << " samples";
+  if( m_count == 0 )
+  {
+    stream << std::endl;
+    return;
+  }
+
+  auto flags = stream.flags();
+  auto precision = stream.precision();
+  stream << std::fixed << std::setprecision(1)
+         << ", mean " << mean() << "ms"
+         << ", p50 " << percentile(50.0) << "ms"
+         << ", p95 " << percentile(95.0) << "ms"
+         << ", p99 " << percentile(99.0) << "ms"
+         << ", max " << max() << "ms" << std::endl;
+
+  for( size_t i = 0; i < m_buckets.size(); ++i )
+  {
+    if( m_buckets[i] == 0 ) continue;
+    stream << "  " << std::setw(5) << i * m_bucketWidthMs << " - "
+           << std::setw(5) << (i + 1) * m_bucketWidthMs << "ms: "
+           << m_buckets[i] << std::endl;
+  }
+  if( m_overflow )
+  {
+    stream << "  " << std::setw(5) << m_buckets.size() * m_bucketWidthMs << "ms+     : " << m_overflow << std::endl;
+  }
+  stream.flags( flags );
+  stream.precision( precision );
+}
@@ -0,0 +1,83 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Fixed bucket histogram of latencies, in milliseconds
+ * Samples past the last bucket are counted in an overflow bucket
+ */
+class LatencyHistogram
+{
+public:
+  LatencyHistogram( const std::string& name, double bucketWidthMs = 1.0, unsigned int numBuckets = 64 );
+  ~LatencyHistogram();
+
+  void add( double latencyMs );
+
+  unsigned int count() const;
+  double mean() const;
+  double max() const;
+  /// Approximate percentile (0-100), resolution is the bucket width
+  double percentile( double p ) const;
+
+  void report( std::ostream& stream ) const;
+
+private:
+  std::string m_name;
+  double m_bucketWidthMs;
+  std::vector<unsigned int> m_buckets;
+  unsigned int m_overflow;
+  unsigned int m_count;
+  double m_total;
+  double m_max;
+};
+
+inline unsigned int LatencyHistogram::count() const
+{
+  return m_count;
+}
+
+inline double LatencyHistogram::mean() const
+{
+  return m_count ? m_total / m_count : 0.0;
+}
+
+inline double LatencyHistogram::max() const
+{
+  return m_max;
+}
+
+#endif
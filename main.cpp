@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <osgViewer/Viewer>
 #include <osg/PositionAttitudeTransform>
 #include <osg/MatrixTransform>
+#include <osg/Stats>
 
 #include <osgGA/TrackballManipulator>
 #include <osgGA/NodeTrackerManipulator>
@@ -47,7 +48,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "main.h"
 #include "menuentry.h"
 #include "inputhandler.h"
-
+#include "latencyhistogram.h"
+#include "qualitycontroller.h"
+#include "renderscaler.h"
+#ifdef OSGLAUNCHER_EVDEV
+#include "evdevinput.h"
+#endif
+#ifdef OSGLAUNCHER_SOURCES
+#include "entryscanner.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
 #include <memory>
 
 int main(int argc, const char** argv)
@@ -71,6 +85,22 @@ int Main::run(int argc, const char** argv)
   }
 
   std::shared_ptr<std::vector<std::shared_ptr<MenuEntry>>> entries( new std::vector<std::shared_ptr<MenuEntry>>() );
+#ifdef OSGLAUNCHER_EVDEV
+  EvdevInput evdevInput;
+#endif
+
+  // Config in document order, each item is either a fixed entry or an entry source
+  struct ConfigItem
+  {
+    std::shared_ptr<MenuEntry> entry;
+    size_t source;
+  };
+  std::vector<ConfigItem> configItems;
+#ifdef OSGLAUNCHER_SOURCES
+  EntryScanner entryScanner( EntryIndex::defaultPath( argv[1] ) );
+  EntryScanner::Results sourceEntries;
+  EntryScanner::Images sourceImages;
+#endif
 
   {
     const char* configXML{ argv[1] };
@@ -82,26 +112,121 @@ int Main::run(int argc, const char** argv)
       return 1;
     }
 
-    // We're looking for:
-    // - menu
-    // - menuentry (one or more)
-    tinyxml2::XMLElement* entry{ doc.FirstChildElement("menuentry") };
-    if( entry == nullptr )
+    // We're looking for, in any order:
+    // - menuentry (zero or more)
+    // - source (zero or more, generating entries)
+    for( auto element = doc.FirstChildElement(); element != nullptr; element = element->NextSiblingElement() )
+    {
+      if( std::strcmp( element->Name(), "menuentry" ) == 0 )
+      {
+        ConfigItem item{ std::shared_ptr<MenuEntry>( new MenuEntry(element, configXML) ), 0 };
+        configItems.push_back( item );
+      }
+      else if( std::strcmp( element->Name(), "source" ) == 0 )
+      {
+#ifdef OSGLAUNCHER_SOURCES
+        std::shared_ptr<EntrySource> source( new EntrySource(element, configXML) );
+        if( !source->valid() )
+        {
+          return 1;
+        }
+        ConfigItem item{ nullptr, entryScanner.addSource( source ) };
+        configItems.push_back( item );
+#else
+        std::cerr << "WARNING: <source> not supported on this platform" << std::endl;
+#endif
+      }
+    }
+    if( configItems.empty() )
     {
-      std::cerr << "Error: No <menuentry> in configuration file" << std::endl;
+      std::cerr << "Error: No <menuentry> or <source> in configuration file" << std::endl;
       return 1;
     }
 
-    std::shared_ptr<MenuEntry> menuEntry( new MenuEntry(entry, configXML) );
-    entries->emplace_back( menuEntry );
+    // Optional input devices besides the keyboard
+    // - input
+    //   - evdev (zero or more, device path or glob, relative to the config file)
+    //     axismin/axismax attributes give the stick range for recordings
+    tinyxml2::XMLElement* input{ doc.FirstChildElement("input") };
+    if( input != nullptr )
+    {
+#ifdef OSGLAUNCHER_EVDEV
+      for( auto evdev = input->FirstChildElement("evdev"); evdev != nullptr; evdev = evdev->NextSiblingElement("evdev") )
+      {
+        if( !evdev->GetText() ) continue;
+        std::string pattern( evdev->GetText() );
+        std::string configFile( configXML );
+        auto lastSlash = configFile.find_last_of('/');
+        if( pattern.compare(0, 1, "/") != 0 && lastSlash != std::string::npos )
+        {
+          pattern = configFile.substr(0, lastSlash + 1) + pattern;
+        }
+
+        int axisMin{ EvdevInput::defaultAxisMin };
+        int axisMax{ EvdevInput::defaultAxisMax };
+        evdev->QueryIntAttribute( "axismin", &axisMin );
+        evdev->QueryIntAttribute( "axismax", &axisMax );
+        evdevInput.addDevices( pattern, axisMin, axisMax );
+      }
+#else
+      std::cerr << "WARNING: <input> devices not supported on this platform" << std::endl;
+#endif
+    }
+  }
+
+#ifdef OSGLAUNCHER_SOURCES
+  if( !entryScanner.empty() )
+  {
+    // Show what was found last time, and pick up any changes in the background
+    // On the first run there's nothing to show until the sources have been scanned
+    if( entryScanner.load() ) entryScanner.startScan();
+    else entryScanner.scan();
+    entryScanner.takeResults( sourceEntries, sourceImages );
+  }
+#endif
 
-    tinyxml2::XMLElement* sibling{ entry->NextSiblingElement("menuentry") };
-    while( sibling != nullptr )
+  // Flatten the config into the list of entries
+  // Source entries which are unchanged keep their MenuEntry, and its scene graph
+  auto collectEntries = [&]()
+  {
+    std::map<std::string, std::shared_ptr<MenuEntry>> previous;
+    for( auto& entry : *entries )
+    {
+      previous[entry->name() + '\n' + entry->command() + '\n' + entry->image()] = entry;
+    }
+    entries->clear();
+
+    for( auto& item : configItems )
     {
-      std::shared_ptr<MenuEntry> menuEntry( new MenuEntry(sibling, configXML) );
-      entries->emplace_back( menuEntry );
-      sibling = sibling->NextSiblingElement("menuentry");
+      if( item.entry )
+      {
+        entries->push_back( item.entry );
+        continue;
+      }
+#ifdef OSGLAUNCHER_SOURCES
+      for( auto& sourceEntry : sourceEntries[item.source] )
+      {
+        auto it = previous.find( sourceEntry.name + '\n' + sourceEntry.command + '\n' + sourceEntry.image );
+        if( it != previous.end() )
+        {
+          entries->push_back( it->second );
+          continue;
+        }
+        std::shared_ptr<MenuEntry> entry( new MenuEntry(sourceEntry.image, sourceEntry.command, sourceEntry.name) );
+        // Loaded by the scanner, so building the scene graph doesn't block on decoding
+        auto image = sourceImages.find( sourceEntry.image );
+        if( image != sourceImages.end() ) entry->setPreloadedImage( image->second );
+        entries->push_back( entry );
+      }
+#endif
     }
+  };
+
+  collectEntries();
+  if( entries->empty() )
+  {
+    std::cerr << "Error: No entries found" << std::endl;
+    return 1;
   }
 
   // OSG setup
@@ -109,29 +234,54 @@ int Main::run(int argc, const char** argv)
   auto* root = new osg::MatrixTransform();
 
   osg::ref_ptr<InputHandler> inputHandler( new InputHandler(this, entries) );
-  viewer.setSceneData( root );
+  RenderScaler renderScaler( root );
+  viewer.setSceneData( renderScaler.root() );
   //viewer.setUpViewInWindow(30, 30, 800, 600);
 
   // Setup scene graph
   // For now just load everything at once as I'm only planning on a few menu entries
   // TODO: Worry about paging in entries to avoid hogging memory
-  double entryPos = 0.0;
   auto entryPosDelta = 1.2;
 
-  for( auto entry : *(entries.get()) )
+  // Limit framerate to 60fps at least otherwise we're just wasting power/to heat the GPU up
+  auto minFrameTime = 1.0 / 60.0;
+
+  // Drops quality when the machine can't keep up with the frame rate
+  QualityController qualityController( minFrameTime );
+
+  auto layoutEntries = [&]()
   {
-    osg::ref_ptr<osg::PositionAttitudeTransform> transform = new osg::PositionAttitudeTransform();
-    transform->setPosition( osg::Vec3d(entryPos, 0.0, 0.0) );
-    entryPos += entryPosDelta;
-    transform->addChild( entry->osgGroup() );
-    root->addChild( transform );
-  }
+    root->removeChildren( 0, root->getNumChildren() );
+    double entryPos = 0.0;
+    auto& quality = qualityController.quality();
+    for( auto entry : *(entries.get()) )
+    {
+      entry->setQuality( quality.textureLODBias, quality.labelResolution );
+      osg::ref_ptr<osg::PositionAttitudeTransform> transform = new osg::PositionAttitudeTransform();
+      transform->setPosition( osg::Vec3d(entryPos, 0.0, 0.0) );
+      entryPos += entryPosDelta;
+      transform->addChild( entry->osgGroup() );
+      root->addChild( transform );
+    }
+  };
+  layoutEntries();
 
   viewer.addEventHandler(inputHandler);
+  // Single threaded so renderingTraversals returns after the buffer swap
+  // The threaded models let draw run a frame behind, adding a frame of input latency
+  viewer.setThreadingModel( osgViewer::ViewerBase::SingleThreaded );
   viewer.realize();
 
-  // Limit framerate to 60fps at least otherwise we're just wasting power/to heat the GPU up
-  auto minFrameTime = 1.0 / 60.0;
+  // Input latency, measured from the event timestamp to when
+  // the frame reflecting it was set up, and to the buffer swap
+  LatencyHistogram inputToFrame( "input to frame" );
+  LatencyHistogram inputToSwap( "input to swap" );
+  std::vector<double> eventTimes;
+  auto eventQueue = viewer.getEventQueue();
+
+#ifdef OSGLAUNCHER_EVDEV
+  evdevInput.start();
+#endif
 
   // The menu entries were written in OpenGL convention (y-up),
   // so need to rotate the world to fit osg's (z-up) convention
@@ -140,13 +290,107 @@ int Main::run(int argc, const char** argv)
   root->setMatrix(mat);
 
   auto cam = viewer.getCamera();
+  renderScaler.setClearColor( cam->getClearColor() );
+
+  // Frame cost for the quality controller, from osg's own instrumentation
+  viewer.getViewerStats()->collectStats( "event", true );
+  viewer.getViewerStats()->collectStats( "update", true );
+  cam->getStats()->collectStats( "rendering", true );
+  cam->getStats()->collectStats( "gpu", true );
+  auto latestStat = []( osg::Stats* stats, const std::string& name ) -> double
+  {
+    // GPU timings arrive a few frames late
+    double value{ 0.0 };
+    auto latest = stats->getLatestFrameNumber();
+    for( unsigned int i = 0; i < 4 && i <= latest; ++i )
+    {
+      if( stats->getAttribute( latest - i, name, value ) ) return value;
+    }
+    return 0.0;
+  };
+  auto frameCost = [&]() -> double
+  {
+    auto cpu = latestStat( viewer.getViewerStats(), "Event traversal time taken" ) +
+               latestStat( viewer.getViewerStats(), "Update traversal time taken" ) +
+               latestStat( cam->getStats(), "Cull traversal time taken" ) +
+               latestStat( cam->getStats(), "Draw traversal time taken" );
+    auto gpu = latestStat( cam->getStats(), "GPU draw time taken" );
+    return std::max( cpu, gpu );
+  };
 
   // Main program loop
+  auto nextFrameTick = osg::Timer::instance()->tick();
+  osg::Timer_t previousStartTick{ 0 };
   while( !viewer.done() )
   {
+    // Wait out the remainder of the frame before sampling input, not after,
+    // so events don't sit in the queue while we sleep
     auto startTick = osg::Timer::instance()->tick();
+    if( startTick < nextFrameTick )
+    {
+      OpenThreads::Thread::microSleep( static_cast<unsigned int>(1e6 * osg::Timer::instance()->delta_s(startTick, nextFrameTick)) );
+      startTick = osg::Timer::instance()->tick();
+    }
+    nextFrameTick = startTick + static_cast<osg::Timer_t>(minFrameTime / osg::Timer::instance()->getSecondsPerTick());
+
+    if( previousStartTick != 0 &&
+        qualityController.frame( osg::Timer::instance()->delta_s(previousStartTick, startTick), frameCost() ) )
+    {
+      auto& quality = qualityController.quality();
+      for( auto& entry : *entries )
+      {
+        entry->setQuality( quality.textureLODBias, quality.labelResolution );
+      }
+      renderScaler.setScale( quality.renderScale );
+    }
+    previousStartTick = startTick;
+
+    // Equivalent to viewer.frame(), split up so input is applied
+    // to the frame being rendered instead of the next one
+    viewer.advance();
+    viewer.eventTraversal();
+
+#ifdef OSGLAUNCHER_EVDEV
+    EvdevInput::Event evdevEvent;
+    while( evdevInput.poll(evdevEvent) )
+    {
+      auto eventTime = osg::Timer::instance()->delta_s(eventQueue->getStartTick(), evdevEvent.tick);
+      switch( evdevEvent.action )
+      {
+        case EvdevInput::Action::Left:
+          inputHandler->step( -1, eventTime );
+          break;
+        case EvdevInput::Action::Right:
+          inputHandler->step( 1, eventTime );
+          break;
+        case EvdevInput::Action::Select:
+          enterPressed();
+          break;
+      }
+    }
+#endif
+
+#ifdef OSGLAUNCHER_SOURCES
+    if( entryScanner.takeResults( sourceEntries, sourceImages ) )
+    {
+      // Keep the same entry selected if it's still there
+      std::shared_ptr<MenuEntry> selected;
+      if( !entries->empty() ) selected = entries->operator[](inputHandler->currentIndex());
+      collectEntries();
+      sourceImages.clear();
+      layoutEntries();
+      auto it = std::find( entries->begin(), entries->end(), selected );
+      inputHandler->setCurrentIndex( it != entries->end() ? static_cast<unsigned int>(it - entries->begin()) : 0 );
+    }
+#endif
+
+    inputHandler->applyPendingInput( eventTimes );
+    auto frameTime = eventQueue->getTime();
+    for( auto t : eventTimes ) inputToFrame.add( 1e3 * (frameTime - t) );
+
     auto currentIndex = inputHandler->currentIndex();
-    std::shared_ptr<MenuEntry> currentEntry( entries->operator[](currentIndex));
+    std::shared_ptr<MenuEntry> currentEntry;
+    if( !entries->empty() ) currentEntry = entries->operator[](currentIndex);
 
     osgViewer::ViewerBase::Contexts context;
     viewer.getContexts(context, true);
@@ -161,13 +405,23 @@ int Main::run(int argc, const char** argv)
     auto viewCenterY = -0.1;
     auto viewHalfHeight = (entryPosDelta / 2.0) * viewScale;
     auto viewHalfWidth = viewHalfHeight * (windowWidth / windowHeight);
-    cam->setProjectionMatrixAsOrtho(
+    auto projection = osg::Matrixd::ortho(
           viewCenterX - viewHalfWidth, viewCenterX + viewHalfWidth,
           viewCenterY - viewHalfHeight, viewCenterY + viewHalfHeight,
           1.0, -1.0
           );
+    cam->setProjectionMatrix( projection );
+    renderScaler.setProjectionMatrix( projection );
+    renderScaler.update( traits->width, traits->height );
+
+    viewer.updateTraversal();
+    viewer.renderingTraversals();
+
+    auto swapTime = eventQueue->getTime();
+    for( auto t : eventTimes ) inputToSwap.add( 1e3 * (swapTime - t) );
 
-    viewer.frame();
+    // Nothing to launch if a rescan removed every entry
+    if( !currentEntry ) m_enterPressed = false;
 
     if( m_enterPressed )
     {
@@ -184,14 +438,19 @@ int Main::run(int argc, const char** argv)
       m_enterPressed = false;
       // Some events can be stuck in the queue while applications are quitting
       viewer.getEventQueue()->clear();
-    }
-
-    auto endTick = osg::Timer::instance()->tick();
-    auto frameTime = osg::Timer::instance()->delta_s(startTick, endTick);
-    if( frameTime < minFrameTime )
-    {
-      OpenThreads::Thread::microSleep( static_cast<unsigned int>(1e6 * (minFrameTime - frameTime)) );
+#ifdef OSGLAUNCHER_EVDEV
+      while( evdevInput.poll(evdevEvent) ) {}
+#endif
+      nextFrameTick = osg::Timer::instance()->tick();
+      // Time spent in the command isn't a slow frame
+      previousStartTick = 0;
     }
   }
+
+#ifdef OSGLAUNCHER_EVDEV
+  evdevInput.stop();
+#endif
+  inputToFrame.report( std::cerr );
+  inputToSwap.report( std::cerr );
   return 0;
 }
@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <osgText/Text>
 
 MenuEntry::MenuEntry( const tinyxml2::XMLElement* xmlEntry, std::string xmlFile )
+  : m_textureLODBias{ 0.0f }
+  , m_labelResolution{ 32 }
 {
   // We're looking for an <image> and a <command>
   // TODO: Error handling
@@ -93,9 +95,12 @@ MenuEntry::MenuEntry( const tinyxml2::XMLElement* xmlEntry, std::string xmlFile
   }
 }
 
-MenuEntry::MenuEntry(const std::string& image, const std::string& command)
+MenuEntry::MenuEntry(const std::string& image, const std::string& command, const std::string& name)
   : m_image( image )
   , m_command( command )
+  , m_name( name )
+  , m_textureLODBias{ 0.0f }
+  , m_labelResolution{ 32 }
 {
 
 }
@@ -142,14 +147,15 @@ osg::ref_ptr<osg::Group> MenuEntry::osgGroup()
     quad->setTexCoordArray( 0, texCoords );
     quad->addPrimitiveSet( new osg::DrawArrays( GL_TRIANGLES, 0, 6 ) );
 
-    osg::ref_ptr<osg::Texture2D> texture( new osg::Texture2D() );
-    osg::ref_ptr<osg::Image> image( osgDB::readImageFile(m_image) );
-    texture->setImage( image );
+    m_texture = new osg::Texture2D();
+    osg::ref_ptr<osg::Image> image( m_preloadedImage ? m_preloadedImage : osgDB::readImageFile(m_image) );
+    m_preloadedImage = nullptr;
+    m_texture->setImage( image );
 
     osg::ref_ptr<osg::Geode> geode = new osg::Geode();
     geode = new osg::Geode();
     geode->addDrawable( quad );
-    geode->getOrCreateStateSet()->setTextureAttributeAndModes(0, texture);
+    geode->getOrCreateStateSet()->setTextureAttributeAndModes(0, m_texture);
 
     m_osgGroup->addChild(geode);
   }
@@ -157,19 +163,49 @@ osg::ref_ptr<osg::Group> MenuEntry::osgGroup()
   // 3D text displaying entry name
   if( !m_name.empty() )
   {
-    osg::ref_ptr<osgText::Text> text = new osgText::Text();
-    text->setFont(Settings::instance().font());
-    text->setCharacterSize( 0.15f );
-    text->setColor(osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    text->setAxisAlignment( osgText::TextBase::XZ_PLANE );
-    text->setPosition( osg::Vec3(0.0f, 0.0f, -0.75f) );
-    text->setText( m_name );
-    text->setAlignment( osgText::TextBase::CENTER_BOTTOM );
+    m_label = new osgText::Text();
+    m_label->setFont(Settings::instance().font());
+    m_label->setCharacterSize( 0.15f );
+    m_label->setColor(osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+    m_label->setAxisAlignment( osgText::TextBase::XZ_PLANE );
+    m_label->setPosition( osg::Vec3(0.0f, 0.0f, -0.75f) );
+    m_label->setText( m_name );
+    m_label->setAlignment( osgText::TextBase::CENTER_BOTTOM );
     osg::ref_ptr<osg::Geode> textGeode = new osg::Geode();
-    textGeode->addDrawable(text);
+    textGeode->addDrawable(m_label);
 
     m_osgGroup->addChild(textGeode);
   }
 
+  applyQuality();
   return m_osgGroup;
 }
+
+void MenuEntry::setPreloadedImage( osg::ref_ptr<osg::Image> image )
+{
+  m_preloadedImage = image;
+}
+
+void MenuEntry::setQuality( float textureLODBias, unsigned int labelResolution )
+{
+  if( textureLODBias == m_textureLODBias && labelResolution == m_labelResolution )
+  {
+    return;
+  }
+  m_textureLODBias = textureLODBias;
+  m_labelResolution = labelResolution;
+  applyQuality();
+}
+
+void MenuEntry::applyQuality()
+{
+  if( m_texture )
+  {
+    m_texture->setLODBias( m_textureLODBias );
+  }
+  if( m_label )
+  {
+    // Glyphs are cached per resolution by the font, so switching back is cheap
+    m_label->setFontResolution( m_labelResolution, m_labelResolution );
+  }
+}
@@ -33,6 +33,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <osg/Image>
 #include <osg/Group>
+#include <osg/Texture2D>
+#include <osgText/Text>
 #include <tinyxml2.h>
 
 #include <string>
@@ -41,18 +43,30 @@ class MenuEntry
 {
 public:
   MenuEntry( const tinyxml2::XMLElement* xmlEntry, std::string xmlFile );
-  MenuEntry(const std::string& image, const std::string& command);
+  MenuEntry(const std::string& image, const std::string& command, const std::string& name = "");
   ~MenuEntry();
 
   std::string& image();
   std::string& command();
   std::string& name();
   osg::ref_ptr<osg::Group> osgGroup();
+  /// Use an image which has already been loaded, instead of reading it in osgGroup
+  void setPreloadedImage( osg::ref_ptr<osg::Image> image );
+
+  /// Rendering quality, may be called before or after osgGroup
+  void setQuality( float textureLODBias, unsigned int labelResolution );
 private:
+  void applyQuality();
+
   std::string m_image;
   std::string m_command;
   std::string m_name;
   osg::ref_ptr<osg::Group> m_osgGroup;
+  osg::ref_ptr<osg::Image> m_preloadedImage;
+  osg::ref_ptr<osg::Texture2D> m_texture;
+  osg::ref_ptr<osgText::Text> m_label;
+  float m_textureLODBias;
+  unsigned int m_labelResolution;
 };
 
 inline std::string& MenuEntry::image()
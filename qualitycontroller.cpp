@@ -0,0 +1,138 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "qualitycontroller.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+  /// Frames per evaluation, half a second at 60fps
+  const unsigned int windowFrames{ 30 };
+  /// A frame counts as missed once it's this far over budget
+  const double missedFrameFactor{ 1.5 };
+  /// Step down if more frames than this are missed in a window
+  const double maxMissedRatio{ 0.1 };
+  /// Step down if the average cost is over this fraction of the budget
+  const double maxLoad{ 0.9 };
+  /// Step up if the average cost is under this fraction of the budget
+  const double minLoad{ 0.5 };
+  /// Windows without problems before stepping back up
+  const unsigned int minStepUpWindows{ 6 };
+  /// Backoff limit, for when stepping up keeps failing
+  const unsigned int maxStepUpWindows{ 120 };
+}
+
+QualityController::QualityController( double frameBudget )
+  : m_frameBudget{ frameBudget }
+  , m_level{ 0 }
+  , m_frames{ 0 }
+  , m_missedFrames{ 0 }
+  , m_totalCost{ 0.0 }
+  , m_windowsAtLevel{ 0 }
+  , m_stableWindows{ 0 }
+  , m_stepUpWindows{ minStepUpWindows }
+  , m_steppedUp{ false }
+{
+  // Cheapest visual impact first
+  m_levels.push_back( { 0.0f, 32, 1.0 } );
+  m_levels.push_back( { 1.0f, 32, 1.0 } );
+  m_levels.push_back( { 1.0f, 16, 1.0 } );
+  m_levels.push_back( { 1.0f, 16, 0.85 } );
+  m_levels.push_back( { 2.0f, 16, 0.7 } );
+  m_levels.push_back( { 2.0f, 16, 0.5 } );
+}
+
+QualityController::~QualityController()
+{
+
+}
+
+bool QualityController::frame( double period, double cost )
+{
+  ++m_frames;
+  if( period > m_frameBudget * missedFrameFactor ) ++m_missedFrames;
+  m_totalCost += cost;
+
+  if( m_frames < windowFrames )
+  {
+    return false;
+  }
+
+  auto missedRatio = static_cast<double>(m_missedFrames) / m_frames;
+  auto load = (m_totalCost / m_frames) / m_frameBudget;
+  m_frames = 0;
+  m_missedFrames = 0;
+  m_totalCost = 0.0;
+  ++m_windowsAtLevel;
+  ++m_stableWindows;
+
+  if( m_steppedUp && m_windowsAtLevel >= m_stepUpWindows )
+  {
+    // The level we stepped up to has held, so a later overload isn't a failed step up
+    m_steppedUp = false;
+    m_stepUpWindows = minStepUpWindows;
+  }
+
+  auto newLevel = m_level;
+  if( (missedRatio > maxMissedRatio || load > maxLoad) && m_level + 1 < m_levels.size() )
+  {
+    // The first window after a change still has frames from before it
+    if( m_windowsAtLevel > 1 ) ++newLevel;
+    if( newLevel != m_level && m_steppedUp )
+    {
+      // The level we came back to can't keep up, wait longer before trying again
+      m_stepUpWindows = std::min( m_stepUpWindows * 2, maxStepUpWindows );
+    }
+  }
+  else if( missedRatio == 0.0 && load < minLoad && m_level > 0 )
+  {
+    if( m_stableWindows >= m_stepUpWindows ) --newLevel;
+  }
+  else if( missedRatio > 0.0 || load > minLoad )
+  {
+    // Not enough headroom to step up yet
+    m_stableWindows = 0;
+  }
+
+  if( newLevel == m_level )
+  {
+    return false;
+  }
+
+  std::cerr << "Info: Quality level " << newLevel << " (load " << static_cast<int>(100.0 * load)
+            << "%, " << static_cast<int>(100.0 * missedRatio) << "% frames missed)" << std::endl;
+  m_steppedUp = newLevel < m_level;
+  m_level = newLevel;
+  m_windowsAtLevel = 0;
+  m_stableWindows = 0;
+  return true;
+}
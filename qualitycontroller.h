@@ -0,0 +1,98 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef QUALITYCONTROLLER_H
+#define QUALITYCONTROLLER_H
+
+#include <vector>
+
+/**
+ * Trades rendering quality for frame rate on slow machines
+ *
+ * Fed with each frame's period and cost (the time spent working, excluding
+ * waiting for the next frame). Quality is stepped down when frames are missed
+ * or the cost is close to the budget, and back up when there's plenty of headroom.
+ * Changes are spaced out so the level doesn't oscillate.
+ */
+class QualityController
+{
+public:
+  struct Quality
+  {
+    /// Added to texture mip level selection, positive is blurrier and cheaper
+    float textureLODBias;
+    /// Glyph resolution for entry labels
+    unsigned int labelResolution;
+    /// Fraction of the window resolution the scene is rendered at
+    double renderScale;
+  };
+
+  QualityController( double frameBudget );
+  ~QualityController();
+
+  /**
+   * Record a frame
+   * @param period Time since the start of the previous frame, in seconds
+   * @param cost Time spent rendering the frame, in seconds
+   * @return true if the quality level changed
+   */
+  bool frame( double period, double cost );
+
+  unsigned int level() const;
+  const Quality& quality() const;
+
+private:
+  double m_frameBudget;
+  std::vector<Quality> m_levels;
+  unsigned int m_level;
+
+  unsigned int m_frames;
+  unsigned int m_missedFrames;
+  double m_totalCost;
+  /// Evaluation windows since the level last changed
+  unsigned int m_windowsAtLevel;
+  /// Evaluation windows in a row with headroom to step up
+  unsigned int m_stableWindows;
+  unsigned int m_stepUpWindows;
+  /// Whether the last change was a step up
+  bool m_steppedUp;
+};
+
+inline unsigned int QualityController::level() const
+{
+  return m_level;
+}
+
+inline const QualityController::Quality& QualityController::quality() const
+{
+  return m_levels[m_level];
+}
+
+#endif
@@ -0,0 +1,142 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "renderscaler.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+
+RenderScaler::RenderScaler( osg::Node* scene )
+  : m_scene( scene )
+  , m_root( new osg::Group() )
+  , m_texture( new osg::Texture2D() )
+  , m_sceneCamera( new osg::Camera() )
+  , m_upscaleCamera( new osg::Camera() )
+  , m_texMat( new osg::TexMat() )
+  , m_scale{ 1.0 }
+  , m_scaling{ false }
+{
+  m_texture->setInternalFormat( GL_RGBA );
+  m_texture->setFilter( osg::Texture::MIN_FILTER, osg::Texture::LINEAR );
+  m_texture->setFilter( osg::Texture::MAG_FILTER, osg::Texture::LINEAR );
+  m_texture->setWrap( osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE );
+  m_texture->setWrap( osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE );
+  m_texture->setResizeNonPowerOfTwoHint( false );
+
+  // Pre-render pass, draws the scene into the texture
+  m_sceneCamera->setRenderOrder( osg::Camera::PRE_RENDER );
+  m_sceneCamera->setRenderTargetImplementation( osg::Camera::FRAME_BUFFER_OBJECT );
+  m_sceneCamera->attach( osg::Camera::COLOR_BUFFER, m_texture );
+  m_sceneCamera->attach( osg::Camera::DEPTH_BUFFER, GL_DEPTH_COMPONENT24 );
+  m_sceneCamera->setReferenceFrame( osg::Camera::ABSOLUTE_RF );
+  m_sceneCamera->setViewMatrix( osg::Matrix::identity() );
+  m_sceneCamera->setClearMask( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+  m_sceneCamera->addChild( m_scene );
+
+  // Stretches the used part of the texture over the window
+  osg::ref_ptr<osg::Geometry> quad( osg::createTexturedQuadGeometry(
+        osg::Vec3( 0.0f, 0.0f, 0.0f ), osg::Vec3( 1.0f, 0.0f, 0.0f ), osg::Vec3( 0.0f, 1.0f, 0.0f ) ) );
+  osg::ref_ptr<osg::Geode> geode( new osg::Geode() );
+  geode->addDrawable( quad );
+  auto stateSet = geode->getOrCreateStateSet();
+  stateSet->setTextureAttributeAndModes( 0, m_texture );
+  stateSet->setTextureAttributeAndModes( 0, m_texMat );
+  stateSet->setMode( GL_LIGHTING, osg::StateAttribute::OFF );
+  stateSet->setMode( GL_DEPTH_TEST, osg::StateAttribute::OFF );
+
+  m_upscaleCamera->setRenderOrder( osg::Camera::NESTED_RENDER );
+  m_upscaleCamera->setReferenceFrame( osg::Camera::ABSOLUTE_RF );
+  m_upscaleCamera->setProjectionMatrixAsOrtho2D( 0.0, 1.0, 0.0, 1.0 );
+  m_upscaleCamera->setViewMatrix( osg::Matrix::identity() );
+  m_upscaleCamera->setClearMask( 0 );
+  m_upscaleCamera->setAllowEventFocus( false );
+  m_upscaleCamera->addChild( geode );
+
+  m_root->addChild( m_scene );
+}
+
+RenderScaler::~RenderScaler()
+{
+
+}
+
+void RenderScaler::setProjectionMatrix( const osg::Matrixd& projection )
+{
+  m_sceneCamera->setProjectionMatrix( projection );
+}
+
+void RenderScaler::setClearColor( const osg::Vec4& color )
+{
+  m_sceneCamera->setClearColor( color );
+}
+
+void RenderScaler::setScale( double scale )
+{
+  m_scale = scale;
+  bool scaling{ m_scale < 1.0 };
+  if( scaling == m_scaling )
+  {
+    return;
+  }
+  m_scaling = scaling;
+
+  m_root->removeChildren( 0, m_root->getNumChildren() );
+  if( m_scaling )
+  {
+    m_root->addChild( m_sceneCamera );
+    m_root->addChild( m_upscaleCamera );
+  }
+  else
+  {
+    m_root->addChild( m_scene );
+  }
+}
+
+void RenderScaler::update( int width, int height )
+{
+  if( !m_scaling || width <= 0 || height <= 0 )
+  {
+    return;
+  }
+
+  // Texture follows the window size, only reallocated when the window is resized
+  if( m_texture->getTextureWidth() != width || m_texture->getTextureHeight() != height )
+  {
+    m_texture->setTextureSize( width, height );
+    m_texture->dirtyTextureObject();
+    m_sceneCamera->dirtyAttachmentMap();
+  }
+
+  auto scaledWidth = static_cast<int>( width * m_scale );
+  auto scaledHeight = static_cast<int>( height * m_scale );
+  m_sceneCamera->setViewport( 0, 0, scaledWidth, scaledHeight );
+  m_texMat->setMatrix( osg::Matrix::scale( static_cast<double>(scaledWidth) / width,
+                                           static_cast<double>(scaledHeight) / height, 1.0 ) );
+}
@@ -0,0 +1,88 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef RENDERSCALER_H
+#define RENDERSCALER_H
+
+#include <osg/Camera>
+#include <osg/Group>
+#include <osg/TexMat>
+#include <osg/Texture2D>
+
+/**
+ * Renders a scene at a fraction of the window resolution and upscales it
+ *
+ * The scene is drawn into a window sized FBO with a reduced viewport, then
+ * stretched over the window, so changing the scale never reallocates anything.
+ * At a scale of 1 the scene is drawn directly, with no extra pass.
+ */
+class RenderScaler
+{
+public:
+  RenderScaler( osg::Node* scene );
+  ~RenderScaler();
+
+  /// Pass to the viewer in place of the scene
+  osg::ref_ptr<osg::Group> root();
+
+  /// Projection for the scene, the main camera's isn't used while scaling
+  void setProjectionMatrix( const osg::Matrixd& projection );
+
+  /// Should match the main camera
+  void setClearColor( const osg::Vec4& color );
+
+  void setScale( double scale );
+  double scale() const;
+
+  /// Call each frame before rendering, with the window size
+  void update( int width, int height );
+
+private:
+  osg::ref_ptr<osg::Node> m_scene;
+  osg::ref_ptr<osg::Group> m_root;
+  osg::ref_ptr<osg::Texture2D> m_texture;
+  osg::ref_ptr<osg::Camera> m_sceneCamera;
+  osg::ref_ptr<osg::Camera> m_upscaleCamera;
+  osg::ref_ptr<osg::TexMat> m_texMat;
+  double m_scale;
+  bool m_scaling;
+};
+
+inline osg::ref_ptr<osg::Group> RenderScaler::root()
+{
+  return m_root;
+}
+
+inline double RenderScaler::scale() const
+{
+  return m_scale;
+}
+
+#endif
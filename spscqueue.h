@@ -0,0 +1,100 @@
+/**
+Copyright (c) 2019, Gareth Francis
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bounded lock-free queue for one producer thread and one consumer thread
+ *
+ * One slot is kept free to tell a full queue from an empty one,
+ * so capacity is one less than the size given.
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+  explicit SPSCQueue( size_t size );
+
+  /// Producer only. Returns false if the queue is full
+  bool push( const T& value );
+  /// Consumer only. Returns false if the queue is empty
+  bool pop( T& value );
+
+private:
+  SPSCQueue( const SPSCQueue& ) = delete;
+  SPSCQueue& operator=( const SPSCQueue& ) = delete;
+
+  std::vector<T> m_slots;
+  std::atomic<size_t> m_head;
+  std::atomic<size_t> m_tail;
+};
+
+template<typename T>
+SPSCQueue<T>::SPSCQueue( size_t size )
+  : m_slots( size < 2 ? 2 : size )
+  , m_head{ 0 }
+  , m_tail{ 0 }
+{
+
+}
+
+template<typename T>
+bool SPSCQueue<T>::push( const T& value )
+{
+  auto tail = m_tail.load( std::memory_order_relaxed );
+  auto next = (tail + 1) % m_slots.size();
+  if( next == m_head.load( std::memory_order_acquire ) )
+  {
+    return false;
+  }
+  m_slots[tail] = value;
+  m_tail.store( next, std::memory_order_release );
+  return true;
+}
+
+template<typename T>
+bool SPSCQueue<T>::pop( T& value )
+{
+  auto head = m_head.load( std::memory_order_relaxed );
+  if( head == m_tail.load( std::memory_order_acquire ) )
+  {
+    return false;
+  }
+  value = m_slots[head];
+  m_head.store( (head + 1) % m_slots.size(), std::memory_order_release );
+  return true;
+}
+
+#endif